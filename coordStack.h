@@ -52,18 +52,14 @@
 #define COORDSTACK_H
 
 #include <iostream>
+#include <vector>
 #include "coordinate.h"
 
 using namespace std;
 
 typedef coordinates stackElement;
 
-class Node
-{
-public:
-	stackElement data;
-    Node *next;
-};
+const int STACK_RESERVE = 64;   //one entry per cell of an 8x8 maze, the deepest a path can go
 
 class stackMoves
 {
@@ -73,56 +69,40 @@ public:
 	stackElement GetTop();
 	void Push(stackElement);
 	void Pop();
-	bool IsEmpty(){return top==0;};
+	bool IsEmpty(){return items.empty();};
 	void Print();
+	void CopyTo(vector <stackElement> &);  //append every element, top first, without popping
 private:
-	Node *top;
+	vector <stackElement> items;   //back is the top; reserved up front so Push never allocates
 };
 
 
 stackMoves::stackMoves()
 {
-	top=0;
+	items.reserve(STACK_RESERVE);
 }
 
 stackMoves::~stackMoves()
 {
-	while(!IsEmpty())
-	{
-		Pop();
-	}
+	items.clear();
 }
 
 stackElement stackMoves::GetTop()
 {
 		//Assuming not called if stack is empty
-		return top->data;
+		return items.back();
 }
 
 void stackMoves::Push(stackElement item)
 {
-	if (IsEmpty())
-	{
-		top = new Node;
-		top->data = item;
-		top->next =0;
-	}
-	else
-	{
-		Node *p = new Node;
-		p->data = item;
-		p->next = top;
-		top = p;
-	}
+	items.push_back(item);
 }
 
 void stackMoves::Pop()
 {
 	if (!IsEmpty())
 	{
-		Node *p=top;
-		top = top->next;
-		delete p;
+		items.pop_back();
 	}
 	else
 	{
@@ -133,11 +113,19 @@ void stackMoves::Pop()
 void stackMoves::Print()
 {
 	cout<<endl<<endl;
-	for (Node* p=top; p!=0; p=p->next)
+	for (size_t x = items.size(); x > 0; x--)
 	{
-		p->data.print();
+		items[x-1].print();
 	}
 	cout<<endl<<endl;
 }
 
+void stackMoves::CopyTo(vector <stackElement> & out)
+{
+	for (size_t x = items.size(); x > 0; x--)
+	{
+		out.push_back(items[x-1]);
+	}
+}
+
 #endif
\ No newline at end of file
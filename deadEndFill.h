@@ -0,0 +1,102 @@
+// ////////////////////////////////////////////////////////////////
+//
+// Project: 8x8 Maze Solver
+// Author: Anzalone, Christopher
+// File: deadEndFill.h
+//
+// \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\
+//
+// DESCRIPTION:
+//
+//		Dead-end filling, done before any search. An open cell
+//		with three (or four) walled neighbours is a dead end and
+//		can never be on a path from start to finish, so it is
+//		sealed with an 8. Sealing one can turn its neighbour
+//		into a dead end, so this repeats until nothing changes.
+//
+//		The 8x8 grid fits exactly in a 64 bit mask, bit
+//		row*8+col, so every row is handled at once: shifting the
+//		mask gives each cell's north/south/east/west neighbour,
+//		and one pass seals every current dead end in the maze
+//		in a handful of instructions.
+//
+//		On a perfect maze (no loops) what's left open is exactly
+//		the solution corridor. On a braided maze a search still
+//		runs, but over far fewer cells.
+//
+// ////////////////////////////////////////////////////////////////
+
+#ifndef DEADENDFILL_H
+#define DEADENDFILL_H
+
+#include <stdint.h>
+
+const uint64_t COLUMN_0 = 0x0101010101010101ULL;   //leftmost cell of every row
+const uint64_t COLUMN_7 = 0x8080808080808080ULL;   //rightmost cell of every row
+
+//bit mask of the open cells (0, 1 or 9) in 64 row-major grid cells
+uint64_t openCells(const char * cells)
+{
+	uint64_t open = 0;
+
+	for (int x = 0; x < 64; x++)
+	{
+		if (cells[x] != '8')
+		{
+			open |= 1ULL << x;
+		}
+	}
+
+	return open;
+}
+
+//bit mask of cells holding the given character
+uint64_t cellsMatching(const char * cells, char value)
+{
+	uint64_t match = 0;
+
+	for (int x = 0; x < 64; x++)
+	{
+		if (cells[x] == value)
+		{
+			match |= 1ULL << x;
+		}
+	}
+
+	return match;
+}
+
+//every cell next to a cell in mask (not including mask itself)
+uint64_t neighbourCells(uint64_t mask)
+{
+	return (mask << 8) | (mask >> 8)
+		| ((mask << 1) & ~COLUMN_0)    //east, without wrapping into the next row
+		| ((mask >> 1) & ~COLUMN_7);   //west, without wrapping into the previous row
+}
+
+//seal dead ends until none are left; cells in keep (start and finish) are never sealed.
+//returns the cells still open
+uint64_t fillDeadEnds(uint64_t open, uint64_t keep)
+{
+	while (true)
+	{
+		//for every cell, is its north/south/west/east neighbour open
+		uint64_t n = open << 8;
+		uint64_t s = open >> 8;
+		uint64_t w = (open << 1) & ~COLUMN_0;
+		uint64_t e = (open >> 1) & ~COLUMN_7;
+
+		//at least two of the four are open
+		uint64_t twoOrMore = (n & s) | (n & w) | (n & e) | (s & w) | (s & e) | (w & e);
+
+		uint64_t dead = open & ~keep & ~twoOrMore;
+		if (dead == 0)
+		{
+			return open;
+		}
+
+		open &= ~dead;
+	}
+}
+
+#endif
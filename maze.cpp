@@ -56,20 +56,137 @@
 //#include "moveStack.h"
 #include "maze.h"
 #include "coordStack.h"
+#include "mazeServer.h"
+#include "mazeCache.h"
+#include <cstdlib>
+#include <cerrno>
 
 using namespace std;
 
-int main()
+//usage: maze [--dead-end-fill] [--cache-size N] [--cache-file path] [input file [output file]]
+//       maze [--dead-end-fill] [--cache-size N] [--cache-file path] --serve <socket path>
+int main(int argc, char * argv[])
 {
+	string inputName = "maze_input.txt";
+	string outputName = "maze_output.txt";
+	string socketName;
+	int positional = 0;
+	mazeCache cache;
+	solverMode mode = SOLVER_DFS;
+
+	for (int x = 1; x < argc; x++)
+	{
+		string arg = argv[x];
+
+		if ((arg == "--serve" || arg == "--cache-size" || arg == "--cache-file") && x + 1 >= argc)
+		{
+			cout<<"Missing value for "<<arg<<endl;
+			return 1;
+		}
+
+		if (arg == "--dead-end-fill")
+		{
+			mode = SOLVER_DEADEND_FILL;
+		}
+		else if (arg == "--serve")
+		{
+			socketName = argv[++x];
+		}
+		else if (arg == "--cache-size")
+		{
+			char * end;
+			string value = argv[++x];
+
+			errno = 0;
+			long capacity = strtol(value.c_str(), &end, 10);
+			if (value.empty() || *end != '\0' || errno == ERANGE || capacity < 0)
+			{
+				cout<<"Invalid value for --cache-size: "<<value<<" (expected a non-negative number)"<<endl;
+				return 1;
+			}
+			cache.setCapacity(capacity);
+		}
+		else if (arg == "--cache-file")
+		{
+			if (!cache.openFile(argv[++x]))
+			{
+				return 1;
+			}
+		}
+		else if (positional == 0)
+		{
+			inputName = arg;
+			positional++;
+		}
+		else
+		{
+			outputName = arg;
+			positional++;
+		}
+	}
+
+	if (!socketName.empty())
+	{
+		mazeServer server;
+		server.setCache(&cache);
+		server.setMode(mode);
+		if (!server.open(socketName))
+		{
+			return 1;
+		}
+		return server.run();
+	}
+
 	MAZE the_maze;
-	the_maze.initializeGrid();
+	mazeStatus status;
+
+	status = the_maze.initializeGrid(inputName);
+	if (status != MAZE_OK)
+	{
+		cout<<describeStatus(status)<<", terminating program."<<endl;
+		the_maze.output_file(outputName);
+		return 1;
+	}
 	the_maze.printGrid();
 
-	the_maze.assignCoords();
+	char cells[64];
+	vector <coordinates> path;
+
+	the_maze.copyCells(cells);   //before solving, move() marks up the grid
+
+	if (cache.enabled() && cache.lookup(cells, mode, status, path))
+	{
+		the_maze.setSolution(status, path);
+	}
+	else
+	{
+		if (mode == SOLVER_DEADEND_FILL)
+		{
+			cout<<"Dead-end filling sealed "<<the_maze.pruneDeadEnds()<<" cells."<<endl;
+		}
+
+		the_maze.assignCoords();
+
+		status = the_maze.move();
+
+		if (cache.enabled())
+		{
+			the_maze.getSolution(path);
+			cache.store(cells, mode, status, path);
+		}
+	}
+
+	if (status != MAZE_OK)
+	{
+		cout<<describeStatus(status)<<"."<<endl;
+	}
 
-	the_maze.move();
+	if (cache.enabled())
+	{
+		cache.printStats();
+	}
 
-	the_maze.output_file();
+	the_maze.output_file(outputName);
 
-	return 0;
-}
\ No newline at end of file
+	return status == MAZE_OK ? 0 : 1;
+}
@@ -53,10 +53,33 @@
 
 #include "coordinate.h"
 #include "coordStack.h"
+#include "deadEndFill.h"
 #include <string>
 #include <vector>
 #include <fstream>
 
+//result of loading or solving a maze, so callers never have to rely on exit()
+enum mazeStatus
+{
+	MAZE_OK = 0,         //grid is valid / solution path found
+	MAZE_BAD_SIZE,       //grid is not 8x8
+	MAZE_BAD_CHAR,       //grid contains something other than 0, 1, 8 or 9
+	MAZE_NO_START,       //no 1 in the grid
+	MAZE_MULTIPLE_START, //more than one 1 in the grid
+	MAZE_NO_FINISH,      //no 9 in the grid
+	MAZE_NO_PATH,        //start and finish exist, but finish is unreachable
+	MAZE_NO_FILE         //input file could not be opened or read
+};
+
+const char * describeStatus(mazeStatus);
+
+//which search produced a solution; part of the result cache key
+enum solverMode
+{
+	SOLVER_DFS = 0,          //stack based depth first search in move()
+	SOLVER_DEADEND_FILL = 1  //pruneDeadEnds() first, then trace the corridor or fall back to move()
+};
+
 //8x8 maze object
 
 class MAZE 
@@ -64,22 +87,31 @@ class MAZE
 public:
 	MAZE();  //constructor for maze class
 	~MAZE();   //destructor for maze class
-	void initializeGrid();  
-	void validateGrid();  //check to see if maze is 8x8
+	mazeStatus initializeGrid(string filename = "maze_input.txt");  
+	mazeStatus loadGrid(const char *);  //load 64 row-major cells from memory instead of a file
+	mazeStatus validateGrid();  //check to see if maze is 8x8 with valid chars, one start and a finish
 	void assignCoords();  //will use coordinate objects to assign them a cell from the maze
 
 
-	void move();     //the below functions will be used within move()
+	mazeStatus move();     //the below functions will be used within move()
 	coordinates * findStartPoint();   //find the starting point of the maze, indicate it within coordinate obj
 	void checkAllDirections();  //will look at every direction until one that is available is found
 	bool identifyCell(int);  //this function will scan the next cell, set its status, and return true if its safe
 	int determineListLoc(int, int);  //determine location of coordinate object inside the vector container
 	                           //given the row and col numbers
 	void undoMove();
+	int pruneDeadEnds();   //seal every dead end before searching, returns how many cells were sealed
+	bool traceCorridor();  //after pruneDeadEnds(), walk a branch-free corridor from start to finish
 
 	void printGrid();
 	void output_Solution();  //print grid
-	void output_file();
+	void output_file(string filename = "maze_output.txt");
+
+	void reset();  //clear all state so the same object can solve another maze
+	void setVerbose(bool on){verbose = on;};  //turn off console tracing for the server
+	void getSolution(vector <coordinates> &);  //copy solution path, start to finish, without emptying the stack
+	void setSolution(mazeStatus, const vector <coordinates> &);  //install a known result (e.g. from the cache) instead of solving
+	void copyCells(char *);  //write the 64 grid cells, row-major, into the given buffer
 
 private:
 	vector <string> grid;   //grid[row][column] ~ grid[vector element][subscript]
@@ -90,10 +122,42 @@ private:
 
 	//pointer to point to current position in the maze of coordinate objects
 	coordinates * travelCoordinate;
+
+	int startRow, startCol;   //start point recorded by validateGrid, so it is never rescanned
+	mazeStatus result;        //outcome of the last load or solve
+	bool verbose;             //print tracing to the console
+	uint64_t corridor;        //cells left open by pruneDeadEnds, 0 if it hasn't run
+	uint64_t finishCells;     //cells holding a 9, set by pruneDeadEnds
 };
 
+const char * describeStatus(mazeStatus status)
+{
+	switch (status)
+	{
+	case MAZE_OK:             return "OK";
+	case MAZE_BAD_SIZE:       return "Maze is not 8x8";
+	case MAZE_BAD_CHAR:       return "Invalid character in maze";
+	case MAZE_NO_START:       return "No starting point in maze";
+	case MAZE_MULTIPLE_START: return "More than one starting point in maze";
+	case MAZE_NO_FINISH:      return "No finish point in maze";
+	case MAZE_NO_PATH:        return "No path from start to finish";
+	case MAZE_NO_FILE:        return "Error opening or reading maze file";
+	}
+	return "Unknown maze status";
+}
+
 MAZE::MAZE()
 {
+	travelCoordinate = 0;
+	startRow = startCol = -1;
+	result = MAZE_OK;
+	verbose = true;
+	corridor = finishCells = 0;
+
+	//pre-size workspaces (the move stack reserves its own 64 entries) so a reused maze never reallocates
+	grid.reserve(8);
+	gridCoordinates.reserve(64);
+
 	//initialize coordinatesLink pointers
 	for (int x = 0; x < 64; x++)
 	{
@@ -107,10 +171,25 @@ MAZE::~MAZE()
 	travelCoordinate = 0;
 }
 
-void MAZE::initializeGrid() 
+void MAZE::reset()
+{
+	grid.clear();
+	gridCoordinates.clear();
+
+	while (!gridMoves.IsEmpty())
+	{
+		gridMoves.Pop();
+	}
+
+	travelCoordinate = 0;
+	startRow = startCol = -1;
+	result = MAZE_OK;
+	corridor = finishCells = 0;
+}
+
+mazeStatus MAZE::initializeGrid(string filename) 
 {
 	string row;          //temporary storage for each row that is read from file
-	string filename="maze_input.txt";      //string to store name of file
 	ifstream mazeFile;    //input file stream object representing the maze file
 
 /*	cout<<"Please enter the filename for the maze, including the extension."<<endl;
@@ -118,30 +197,121 @@ void MAZE::initializeGrid()
 
 	mazeFile.open(filename);   //open file
 
-	//error opening file
-	while (!mazeFile)
+	//error opening file; report it rather than prompting, the name came from the caller
+	if (!mazeFile)
 	{
-		if (mazeFile.fail())	
-		{
-			mazeFile.clear();
-			cout<<"\nError opening file, try again.\n"<<endl;
-			cout<<"Please enter the filename for the maze.";
-			cin>>filename;
-			mazeFile.open(filename.c_str());
-		}
+		return result = MAZE_NO_FILE;
 	}
 
+	bool blankSeen = false;   //blank lines are only allowed after the last row
+
 	//read in maze from file into grid container
-	while (!mazeFile.eof())
+	while (getline(mazeFile, row))   //read in next row from input file, into string var
 	{
-		cout<<"in reading loop"<<endl;
-		getline(mazeFile, row);   //read in next row from input file, into string var
+		if (verbose)
+		{
+			cout<<"in reading loop"<<endl;
+		}
+
+		if (!row.empty() && row[row.size()-1] == '\r')   //tolerate CRLF line endings
+		{
+			row.erase(row.size()-1);
+		}
+
+		if (row.empty())
+		{
+			blankSeen = true;
+			continue;
+		}
+
+		//a ninth row, or a row after a blank line, can't be an 8x8 maze; stop reading now
+		if (blankSeen || grid.size() == 8)
+		{
+			mazeFile.close();
+			return result = MAZE_BAD_SIZE;
+		}
 
 		grid.push_back(row);
+	}
 
+	//getline stops on a read error too (e.g. the name is a directory), not only at end of file
+	if (mazeFile.bad() || !mazeFile.eof())
+	{
+		mazeFile.close();
+		return result = MAZE_NO_FILE;
 	}
 
 	mazeFile.close();
+
+	return validateGrid();
+}
+
+mazeStatus MAZE::loadGrid(const char * cells)
+{
+	grid.clear();
+
+	for (int x=0; x < 8; x++)
+	{
+		grid.push_back(string(cells + x*8, 8));
+	}
+
+	return validateGrid();
+}
+
+mazeStatus MAZE::validateGrid()
+{
+	//single pass over the grid: size, characters, start and finish are all
+	//checked here so the solver never has to probe an invalid cell
+	bool finishFound = false;
+
+	startRow = startCol = -1;
+
+	if (grid.size() != 8)
+	{
+		return result = MAZE_BAD_SIZE;
+	}
+
+	for (int x=0; x < 8; x++)
+	{
+		if (grid[x].size() != 8)
+		{
+			return result = MAZE_BAD_SIZE;
+		}
+
+		for (int y=0; y < 8; y++)
+		{
+			switch (grid[x][y])
+			{
+			case '0':
+			case '8':
+				break;
+			case '1':
+				if (startRow != -1)
+				{
+					return result = MAZE_MULTIPLE_START;
+				}
+				startRow = x;
+				startCol = y;
+				break;
+			case '9':
+				finishFound = true;
+				break;
+			default:
+				return result = MAZE_BAD_CHAR;
+			}
+		}
+	}
+
+	if (startRow == -1)
+	{
+		return result = MAZE_NO_START;
+	}
+	if (!finishFound)
+	{
+		return result = MAZE_NO_FINISH;
+	}
+
+	return result = MAZE_OK;
 }
 
 void MAZE::printGrid()
@@ -162,6 +332,9 @@ void MAZE::assignCoords()  //now we have a coordinate object to represent each c
 {
 	coordinates tempCoord;
 	int linkCount = 0;
+
+	gridCoordinates.clear();
+
 	//assign coordinates in terms of the grid, to 64 coordinate objects
 	for (int x=0; x < 8; x++)
 	{
@@ -177,7 +350,7 @@ void MAZE::assignCoords()  //now we have a coordinate object to represent each c
 	}
 
 	//print coordinates objects, FOR TESTING PURPOSES
-	for (int x=0; x < 64; x++)
+	for (int x=0; verbose && x < 64; x++)
 	{
 		cout<<x<<": ";
 		gridCoordinates[x].print();
@@ -191,26 +364,17 @@ void MAZE::assignCoords()  //now we have a coordinate object to represent each c
 
 coordinates * MAZE::findStartPoint()       //~DONE
 {
-	//scan 8x8 grid (grid var for a value of 1)
-	for (int x=0; x < 8; x++)
+	//start point was already located by validateGrid, no need to rescan the grid
+	if (startRow == -1)
 	{
-		for (int y=0; y < 8; y++)
-		{
-			if (grid[x][y] == '1')
-			{
-			//	gridCoordinates (use coordinatesLink to reference correct coordinate object inside vector)
-			//	determineListLoc(x, y);  //get the element cell number representing the x, y coordinates
-
-				//get the element cell number representing the x, y coordinates from determineListLoc, then
-				//refer to coordinate object through coordinateLink, and set it's status for start point
-				coordinatesLink[determineListLoc(x, y)]->status = 1;
-				return coordinatesLink[determineListLoc(x, y)];  //returns pointer to starting coordinate
-			}
-		}
+		return 0;
 	}
-	//if no starting point is found, return -1
-	cout<<"No starting point in maze, terminating program."<<endl;
-	exit(0);
+
+	//get the element cell number representing the x, y coordinates from determineListLoc, then
+	//refer to coordinate object through coordinateLink, and set it's status for start point
+	int startLoc = determineListLoc(startRow, startCol);
+	coordinatesLink[startLoc]->status = 1;
+	return coordinatesLink[startLoc];  //returns pointer to starting coordinate
 }
 
 int MAZE::determineListLoc(int row, int col)     //~DONE
@@ -318,7 +482,10 @@ void MAZE::checkAllDirections()  //parameters represent the x,y coordinates of c
 
 	if (directionCtrl != true)  //dead end, retrace a step, and run the checkAlldirections again
 	{
-		cout<<"No where to go, dead end."<<endl;
+		if (verbose)
+		{
+			cout<<"No where to go, dead end."<<endl;
+		}
 		/*NEED TO MAKE FUNCTION TO UNDO MOVES*/
 		undoMove();
 	}
@@ -335,22 +502,120 @@ void MAZE::undoMove()
 	grid[travelCoordinate->rowNum][travelCoordinate->colNum] = '8';
 	gridMoves.Pop();
 
-	coordinates * tempCoord;
-	tempCoord = &(gridMoves.GetTop());
-	travelCoordinate = coordinatesLink[determineListLoc(tempCoord->rowNum, tempCoord->colNum)];
+	//backed out of the starting point, every path has been exhausted
+	if (gridMoves.IsEmpty())
+	{
+		result = MAZE_NO_PATH;
+		return;
+	}
+
+	coordinates tempCoord = gridMoves.GetTop();
+	travelCoordinate = coordinatesLink[determineListLoc(tempCoord.rowNum, tempCoord.colNum)];
 //	travelCoordinate = &(gridMoves.GetTop());   //point travelCoordinate to addressof last cell
 }
 
-void MAZE::move()
+int MAZE::pruneDeadEnds()
 {
+	char cells[64];
+	int sealed = 0;
+
+	if (result != MAZE_OK)
+	{
+		return 0;
+	}
+
+	copyCells(cells);
+
+	uint64_t open = openCells(cells);
+	finishCells = cellsMatching(cells, '9');
+	corridor = fillDeadEnds(open, finishCells | cellsMatching(cells, '1'));
+
+	//write the sealed cells back into the grid as walls, so move() never enters them
+	for (int x = 0; x < 64; x++)
+	{
+		if ((open & ~corridor) & (1ULL << x))
+		{
+			grid[x / 8][x % 8] = '8';
+			sealed++;
+		}
+	}
+
+	return sealed;
+}
+
+bool MAZE::traceCorridor()
+{
+	coordinates * start = travelCoordinate;
+	uint64_t position = 1ULL << (startRow*8 + startCol);
+	uint64_t visited = position;
+
+	while (true)
+	{
+		uint64_t next = neighbourCells(position) & corridor & ~visited;
+
+		if (next & finishCells)
+		{
+			next &= finishCells;
+			next &= ~(next - 1);   //step onto one finish cell if several touch
+		}
+		else if (next == 0 || (next & (next - 1)) != 0)
+		{
+			//a loop or a fork, the corridor isn't a single path; leave it to move()
+			while (!gridMoves.IsEmpty())
+			{
+				gridMoves.Pop();
+			}
+			travelCoordinate = start;
+			gridMoves.Push( *(travelCoordinate) );
+			return false;
+		}
+
+		visited |= next;
+		position = next;
+
+		//gridCoordinates is row-major, so the bit number is the list location
+		travelCoordinate = coordinatesLink[__builtin_ctzll(next)];
+		gridMoves.Push( *(travelCoordinate) );
+
+		if (next & finishCells)
+		{
+			travelCoordinate->status = 9;
+			return true;
+		}
+	}
+}
+
+mazeStatus MAZE::move()
+{
+	//refuse to solve a grid that failed validation
+	if (result != MAZE_OK)
+	{
+		return result;
+	}
 
 	//find the starting point, mark its status, and assign it to the temp coordinate
 	travelCoordinate = findStartPoint();
 
+	if (travelCoordinate == 0)
+	{
+		return result = MAZE_NO_START;
+	}
+
 	//push starting point onto stack
 	gridMoves.Push( *(travelCoordinate) );
 
-	while (travelCoordinate->status != 9)  //while the travelCoordinate does not equal the finish point
+	//on a perfect maze the pruned grid is a single corridor, no search needed
+	if (corridor != 0 && traceCorridor())
+	{
+		if (verbose)
+		{
+			(*this).output_Solution();
+		}
+		return result;
+	}
+
+	//while the travelCoordinate does not equal the finish point and there are moves left
+	while (travelCoordinate->status != 9 && result == MAZE_OK)
 	{
 		//identify next cell: scan it and give it a status
 		//depending on identification, validateMove will determine whether we move to the spot
@@ -360,9 +625,22 @@ void MAZE::move()
 		//need a function (checkDirections()) to check all directions, should take parameter that represents where last move came from
 		checkAllDirections();
 	}
-	cout<<"Now outside while loop"<<endl;
+	if (verbose)
+	{
+		cout<<"Now outside while loop"<<endl;
+	}
+
+	if (result != MAZE_OK)
+	{
+		return result;
+	}
+
+	if (verbose)
+	{
+		(*this).output_Solution();
+	}
 
-	(*this).output_Solution();
+	return result;
 }
 
 bool MAZE::identifyCell(int nextCoordLoc/*int coordX, int coordY*/) //params will be array location of coordinate of cell to check
@@ -407,16 +685,60 @@ bool MAZE::identifyCell(int nextCoordLoc/*int coordX, int coordY*/) //params wil
 	}
 	else
 	{
-		cout<<"Invalid character in maze"<<endl;
+		//unreachable for a grid that passed validateGrid
 		return 0;
 	}
 }
 
-void MAZE::output_file()
+void MAZE::getSolution(vector <coordinates> & path)
+{
+	path.clear();
+
+	if (result != MAZE_OK)
+	{
+		return;
+	}
+
+	gridMoves.CopyTo(path);   //top of stack first, i.e. finish to start
+
+	//mirror it so the path reads from start to finish
+	for (size_t x = 0, y = path.size(); x + 1 < y; x++, y--)
+	{
+		swap(path[x], path[y-1]);
+	}
+}
+
+void MAZE::setSolution(mazeStatus status, const vector <coordinates> & path)
+{
+	while (!gridMoves.IsEmpty())
+	{
+		gridMoves.Pop();
+	}
+
+	for (size_t x = 0; x < path.size(); x++)
+	{
+		gridMoves.Push(path[x]);
+	}
+
+	result = status;
+}
+
+void MAZE::copyCells(char * cells)
+{
+	for (int x=0; x < 8; x++)
+	{
+		for (int y=0; y < 8; y++)
+		{
+			cells[x*8 + y] = grid[x][y];
+		}
+	}
+}
+
+void MAZE::output_file(string filename)
 {
 	coordinates tempCoord;
 	ofstream outFile;
-	outFile.open ("maze_output.txt");
+	outFile.open (filename.c_str());
 
 	stackMoves reverseStack;
 
@@ -428,6 +750,13 @@ void MAZE::output_file()
 		gridMoves.Pop();
 	}
 
+	if (result != MAZE_OK)
+	{
+		outFile << describeStatus(result) << endl;
+		outFile.close();
+		return;
+	}
+
 	outFile << "The path through the maze is as follows:"<<endl;
 
 	//output to file
@@ -0,0 +1,348 @@
+// ////////////////////////////////////////////////////////////////
+//
+// Project: 8x8 Maze Solver
+// Author: Anzalone, Christopher
+// File: mazeCache.h
+//
+// \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\
+//
+// DESCRIPTION:
+//
+//		Solution cache so that a maze which has been solved
+//		before is answered without searching it again.
+//
+//		Entries are keyed by an FNV-1a hash of the 64 grid
+//		cells plus the solver mode. The grid already holds the
+//		start (1) and finish (9), so the start/finish pair is
+//		part of the key for free. The full cells are kept with
+//		each entry and compared on lookup, so a hash collision
+//		can never return the wrong path.
+//
+//		The in-memory tier is a least recently used list capped
+//		at a fixed number of entries. The optional on-disk tier
+//		is an append-only file of fixed size records; it is
+//		indexed when opened, and a record found there is
+//		promoted into memory. New records are buffered and
+//		written out by flush(), not one syscall per record.
+//
+//		Only MAZE_OK and MAZE_NO_PATH are cached. Invalid grids
+//		are rejected by a single validation pass, which is
+//		already cheaper than a lookup, and caching them would
+//		let junk input evict real solutions.
+//
+// ////////////////////////////////////////////////////////////////
+
+#ifndef MAZECACHE_H
+#define MAZECACHE_H
+
+#include "coordinate.h"
+#include "maze.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <stdint.h>
+
+const int CACHE_CELLS = 64;                                //grid bytes per entry
+const int CACHE_RECORD = CACHE_CELLS + 3 + CACHE_CELLS*2;  //cells, mode, status, length, path pairs
+
+class cacheEntry
+{
+public:
+	uint64_t hash;
+	char cells[CACHE_CELLS];
+	int mode;
+	mazeStatus status;
+	vector <coordinates> path;
+};
+
+class mazeCache
+{
+public:
+	mazeCache();
+	~mazeCache();
+	void setCapacity(size_t n){capacity = n; trim();};  //max entries held in memory, 0 disables the memory tier
+	bool openFile(string);   //attach the on-disk tier, false if the file can't be opened
+	bool enabled(){return capacity > 0 || diskFile != 0;};
+
+	bool lookup(const char *, int, mazeStatus &, vector <coordinates> &);  //true on a hit, fills status and path
+	void store(const char *, int, mazeStatus, const vector <coordinates> &);
+	void flush();   //push buffered records to the file
+
+	unsigned long getHits(){return hits;};          //answered from memory
+	unsigned long getDiskHits(){return diskHits;};  //answered from the file
+	unsigned long getMisses(){return misses;};
+	size_t getSize(){return entries.size();};
+	void printStats();
+
+private:
+	uint64_t hashKey(const char *, int);
+	void insert(const cacheEntry &);
+	void trim();
+	bool readRecord(long, cacheEntry &);
+	void writeRecord(const cacheEntry &);
+
+	size_t capacity;
+	list <cacheEntry> entries;   //front is most recently used
+	unordered_map <uint64_t, list <cacheEntry>::iterator> index;
+
+	FILE * diskFile;
+	unordered_map <uint64_t, long> diskIndex;   //hash to record offset in the file
+	long diskEnd;        //offset just past the last complete record
+	bool diskReading;    //last file operation was a read, so a write must seek first
+	int diskPending;     //records written since the last flush
+
+	unsigned long hits, diskHits, misses;
+};
+
+mazeCache::mazeCache()
+{
+	capacity = 0;
+	diskFile = 0;
+	diskEnd = 0;
+	diskReading = false;
+	diskPending = 0;
+	hits = diskHits = misses = 0;
+}
+
+mazeCache::~mazeCache()
+{
+	if (diskFile != 0)
+	{
+		fclose(diskFile);
+	}
+}
+
+uint64_t mazeCache::hashKey(const char * cells, int mode)
+{
+	uint64_t h = 14695981039346656037ULL;   //FNV-1a offset basis
+
+	for (int x = 0; x < CACHE_CELLS; x++)
+	{
+		h = (h ^ (unsigned char)cells[x]) * 1099511628211ULL;
+	}
+
+	return (h ^ (unsigned char)mode) * 1099511628211ULL;
+}
+
+bool mazeCache::openFile(string filename)
+{
+	cacheEntry entry;
+	long offset = 0;
+
+	diskFile = fopen(filename.c_str(), "r+b");
+	if (diskFile == 0)
+	{
+		diskFile = fopen(filename.c_str(), "w+b");   //first run, create it
+	}
+	if (diskFile == 0)
+	{
+		cout<<"Could not open cache file "<<filename<<endl;
+		return false;
+	}
+
+	//new records go after the last whole record; a torn record at the end is overwritten
+	if (fseek(diskFile, 0, SEEK_END) != 0)
+	{
+		cout<<"Could not read cache file "<<filename<<endl;
+		fclose(diskFile);
+		diskFile = 0;
+		return false;
+	}
+	diskEnd = ftell(diskFile);
+	diskEnd -= diskEnd % CACHE_RECORD;
+
+	//index every whole record, skipping corrupt ones so the records after them still count
+	diskIndex.clear();
+	for (offset = 0; offset < diskEnd; offset += CACHE_RECORD)
+	{
+		if (readRecord(offset, entry))
+		{
+			diskIndex[entry.hash] = offset;
+		}
+	}
+
+	return true;
+}
+
+bool mazeCache::lookup(const char * cells, int mode, mazeStatus & status, vector <coordinates> & path)
+{
+	uint64_t h = hashKey(cells, mode);
+
+	unordered_map <uint64_t, list <cacheEntry>::iterator>::iterator found = index.find(h);
+	if (found != index.end())
+	{
+		list <cacheEntry>::iterator entry = found->second;
+
+		if (entry->mode == mode && memcmp(entry->cells, cells, CACHE_CELLS) == 0)
+		{
+			entries.splice(entries.begin(), entries, entry);   //mark most recently used
+			status = entry->status;
+			path = entry->path;
+			hits++;
+			return true;
+		}
+	}
+
+	if (diskFile != 0)
+	{
+		unordered_map <uint64_t, long>::iterator onDisk = diskIndex.find(h);
+		cacheEntry entry;
+
+		if (onDisk != diskIndex.end() && readRecord(onDisk->second, entry)
+			&& entry.mode == mode && memcmp(entry.cells, cells, CACHE_CELLS) == 0)
+		{
+			status = entry.status;
+			path = entry.path;
+			insert(entry);
+			diskHits++;
+			return true;
+		}
+	}
+
+	misses++;
+	return false;
+}
+
+void mazeCache::store(const char * cells, int mode, mazeStatus status, const vector <coordinates> & path)
+{
+	cacheEntry entry;
+
+	//validation failures are cheaper to recompute than to look up
+	if (status != MAZE_OK && status != MAZE_NO_PATH)
+	{
+		return;
+	}
+
+	entry.hash = hashKey(cells, mode);
+	memcpy(entry.cells, cells, CACHE_CELLS);
+	entry.mode = mode;
+	entry.status = status;
+	entry.path = path;
+
+	insert(entry);
+
+	if (diskFile != 0 && diskIndex.find(entry.hash) == diskIndex.end())
+	{
+		writeRecord(entry);
+	}
+}
+
+void mazeCache::insert(const cacheEntry & entry)
+{
+	if (capacity == 0)
+	{
+		return;
+	}
+
+	unordered_map <uint64_t, list <cacheEntry>::iterator>::iterator found = index.find(entry.hash);
+	if (found != index.end())
+	{
+		entries.erase(found->second);
+	}
+
+	entries.push_front(entry);
+	index[entry.hash] = entries.begin();
+
+	trim();
+}
+
+void mazeCache::trim()
+{
+	//evict least recently used entries until we're back under capacity
+	while (entries.size() > capacity)
+	{
+		index.erase(entries.back().hash);
+		entries.pop_back();
+	}
+}
+
+bool mazeCache::readRecord(long offset, cacheEntry & entry)
+{
+	unsigned char record[CACHE_RECORD];
+	coordinates step;
+
+	diskReading = true;
+	if (fseek(diskFile, offset, SEEK_SET) != 0 || fread(record, 1, CACHE_RECORD, diskFile) != (size_t)CACHE_RECORD)
+	{
+		return false;
+	}
+
+	//store() only ever writes these two statuses, and only a solved maze has a path
+	int status = record[CACHE_CELLS + 1];
+	int length = record[CACHE_CELLS + 2];
+	if (length > CACHE_CELLS
+		|| (status != MAZE_OK && status != MAZE_NO_PATH)
+		|| (status == MAZE_NO_PATH && length != 0))
+	{
+		return false;
+	}
+
+	memcpy(entry.cells, record, CACHE_CELLS);
+	entry.mode = record[CACHE_CELLS];
+	entry.status = (mazeStatus)status;
+	entry.hash = hashKey(entry.cells, entry.mode);
+
+	entry.path.clear();
+	for (int x = 0; x < length; x++)
+	{
+		step.rowNum = record[CACHE_CELLS + 3 + x*2];
+		step.colNum = record[CACHE_CELLS + 4 + x*2];
+		entry.path.push_back(step);
+	}
+
+	return true;
+}
+
+void mazeCache::writeRecord(const cacheEntry & entry)
+{
+	unsigned char record[CACHE_RECORD];
+
+	memset(record, 0, CACHE_RECORD);
+	memcpy(record, entry.cells, CACHE_CELLS);
+	record[CACHE_CELLS] = (unsigned char)entry.mode;
+	record[CACHE_CELLS + 1] = (unsigned char)entry.status;
+	record[CACHE_CELLS + 2] = (unsigned char)entry.path.size();
+
+	for (size_t x = 0; x < entry.path.size(); x++)
+	{
+		record[CACHE_CELLS + 3 + x*2] = (unsigned char)entry.path[x].rowNum;
+		record[CACHE_CELLS + 4 + x*2] = (unsigned char)entry.path[x].colNum;
+	}
+
+	//consecutive writes stay in the stdio buffer; only switching from a read needs a seek
+	if (diskReading)
+	{
+		if (fseek(diskFile, diskEnd, SEEK_SET) != 0)
+		{
+			return;
+		}
+		diskReading = false;
+	}
+
+	if (fwrite(record, 1, CACHE_RECORD, diskFile) == (size_t)CACHE_RECORD)
+	{
+		diskIndex[entry.hash] = diskEnd;
+		diskEnd += CACHE_RECORD;
+		diskPending++;
+	}
+}
+
+void mazeCache::flush()
+{
+	if (diskFile != 0 && diskPending > 0)
+	{
+		fflush(diskFile);
+		diskPending = 0;
+	}
+}
+
+void mazeCache::printStats()
+{
+	cout<<"Cache: "<<hits<<" memory hits, "<<diskHits<<" disk hits, "
+		<<misses<<" misses, "<<entries.size()<<" entries in memory"<<endl;
+}
+
+#endif
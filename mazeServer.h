@@ -0,0 +1,430 @@
+// ////////////////////////////////////////////////////////////////
+//
+// Project: 8x8 Maze Solver
+// Author: Anzalone, Christopher
+// File: mazeServer.h
+//
+// \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\
+//
+// DESCRIPTION:
+//
+//		Server mode for the maze solver. Instead of reading
+//		"maze_input.txt" once and exiting, the program listens
+//		on a Unix domain socket and keeps a single MAZE object
+//		warm, resetting it between requests.
+//
+//		Every message in either direction is a frame: a 4 byte
+//		length in network byte order, followed by that many
+//		bytes of payload.
+//
+//		Request payload: one or more mazes, 64 bytes each, the
+//		8 rows of the grid back to back with no newlines. The
+//		payload length must be a multiple of 64.
+//
+//		Response payload: one result per maze, in order. Each
+//		result is 1 byte mazeStatus, 1 byte path length N, then
+//		N (row, col) byte pairs from start to finish. N is 0
+//		unless the status is MAZE_OK.
+//
+//		A client may write several request frames before reading
+//		any responses; they are answered in the order received.
+//		A client that stops reading its answers is not read from
+//		either until it catches up, and one that shuts down its
+//		sending side still gets every answer before it's closed.
+//
+//		An empty request frame asks for cache statistics. The
+//		response is four 4 byte counters in network byte order:
+//		memory hits, disk hits, misses, entries in memory.
+//
+// ////////////////////////////////////////////////////////////////
+
+#ifndef MAZESERVER_H
+#define MAZESERVER_H
+
+#include "maze.h"
+#include "mazeCache.h"
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+const unsigned int MAZE_CELLS = 64;                        //bytes per maze in a request
+const unsigned int MAX_FRAME = MAZE_CELLS * 4096;         //largest payload accepted before dropping the client
+const unsigned int MAX_INBUF = MAX_FRAME + 4;             //stop reading once a full frame is buffered
+const unsigned int MAX_BACKLOG = MAX_FRAME * 4;           //stop reading and solving while this much output is unsent
+
+class mazeConnection
+{
+public:
+	int fd;
+	vector <char> inBuf;    //bytes received but not yet part of a complete frame
+	vector <char> outBuf;   //responses not yet written
+	size_t outSent;         //how much of outBuf has been written
+	bool readClosed;        //peer shut down its side, finish writing then close
+
+	size_t backlog(){return outBuf.size() - outSent;};
+};
+
+class mazeServer
+{
+public:
+	mazeServer();
+	~mazeServer();
+	bool open(string);   //bind and listen on the given socket path, false on failure
+	int run();           //serve clients until a fatal error, returns nonzero on failure
+	void setCache(mazeCache * c){cache = c;};  //optional, consulted before every solve
+	void setMode(solverMode m){mode = m;};
+
+private:
+	void acceptClient();
+	bool serviceClient(mazeConnection &, short);  //false when the connection should be closed
+	bool readClient(mazeConnection &);    //false when the connection should be dropped
+	bool writeClient(mazeConnection &);   //false when the connection should be dropped
+	bool processFrames(mazeConnection &); //answer every complete frame in inBuf
+	void solveOne(const char *, vector <char> &);
+	void writeStats(vector <char> &);
+	void closeClient(size_t);
+
+	int listenFd;
+	string socketPath;
+	vector <mazeConnection> clients;
+	vector <pollfd> pollList;
+
+	//workspaces reused across every request
+	MAZE solver;
+	vector <coordinates> path;
+	mazeCache * cache;
+	solverMode mode;
+};
+
+mazeServer::mazeServer()
+{
+	listenFd = -1;
+	cache = 0;
+	mode = SOLVER_DFS;
+	solver.setVerbose(false);
+	path.reserve(MAZE_CELLS);
+}
+
+mazeServer::~mazeServer()
+{
+	for (size_t x = 0; x < clients.size(); x++)
+	{
+		close(clients[x].fd);
+	}
+
+	if (listenFd != -1)
+	{
+		close(listenFd);
+		unlink(socketPath.c_str());
+	}
+}
+
+bool mazeServer::open(string socketFile)
+{
+	sockaddr_un addr;
+
+	if (socketFile.size() >= sizeof(addr.sun_path))
+	{
+		cout<<"Socket path is too long: "<<socketFile<<endl;
+		return false;
+	}
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd == -1)
+	{
+		perror("socket");
+		return false;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketFile.c_str());
+
+	unlink(socketFile.c_str());   //remove a stale socket left by a previous run
+
+	if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) == -1 || listen(listenFd, 64) == -1)
+	{
+		perror("bind/listen");
+		close(listenFd);
+		listenFd = -1;
+		return false;
+	}
+
+	fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+	socketPath = socketFile;
+
+	//a client that disconnects mid-write must not kill the server
+	signal(SIGPIPE, SIG_IGN);
+
+	return true;
+}
+
+int mazeServer::run()
+{
+	if (listenFd == -1)
+	{
+		return 1;
+	}
+
+	while (true)
+	{
+		//slot 0 is the listener, slot x+1 is clients[x]
+		pollList.resize(clients.size() + 1);
+		pollList[0].fd = listenFd;
+		pollList[0].events = POLLIN;
+		pollList[0].revents = 0;
+
+		for (size_t x = 0; x < clients.size(); x++)
+		{
+			pollList[x+1].fd = clients[x].fd;
+			pollList[x+1].events = 0;
+
+			//backpressure: leave input in the socket while the client isn't reading its answers
+			if (!clients[x].readClosed && clients[x].backlog() <= MAX_BACKLOG && clients[x].inBuf.size() < MAX_INBUF)
+			{
+				pollList[x+1].events |= POLLIN;
+			}
+			if (clients[x].backlog() > 0)
+			{
+				pollList[x+1].events |= POLLOUT;
+			}
+			pollList[x+1].revents = 0;
+		}
+
+		//write out cache records from the last round in one go before waiting
+		if (cache != 0)
+		{
+			cache->flush();
+		}
+
+		if (poll(&pollList[0], pollList.size(), -1) == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			perror("poll");
+			return 1;
+		}
+
+		//walk backwards so closing a client doesn't shift unvisited slots
+		for (size_t x = clients.size(); x > 0; x--)
+		{
+			if (pollList[x].revents != 0 && !serviceClient(clients[x-1], pollList[x].revents))
+			{
+				closeClient(x-1);
+			}
+		}
+
+		if (pollList[0].revents & POLLIN)
+		{
+			acceptClient();
+		}
+	}
+}
+
+void mazeServer::acceptClient()
+{
+	int fd;
+
+	while ((fd = accept(listenFd, 0, 0)) != -1)
+	{
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+		mazeConnection client;
+		client.fd = fd;
+		client.outSent = 0;
+		client.readClosed = false;
+		clients.push_back(client);
+	}
+}
+
+bool mazeServer::serviceClient(mazeConnection & client, short revents)
+{
+	if (revents & POLLERR)
+	{
+		return false;
+	}
+
+	if (!client.readClosed && (revents & (POLLIN | POLLHUP)) && !readClient(client))
+	{
+		return false;
+	}
+
+	//answer, write, then answer anything that was held back until the write made room
+	if (!processFrames(client) || !writeClient(client) || !processFrames(client))
+	{
+		return false;
+	}
+
+	//a half-closed client is only dropped once every answer has been written
+	return !client.readClosed || client.backlog() > 0;
+}
+
+bool mazeServer::readClient(mazeConnection & client)
+{
+	char buffer[65536];
+
+	//stop once a full frame is buffered; the rest waits in the socket until it's processed
+	while (client.inBuf.size() < MAX_INBUF)
+	{
+		ssize_t got = read(client.fd, buffer, sizeof(buffer));
+
+		if (got > 0)
+		{
+			client.inBuf.insert(client.inBuf.end(), buffer, buffer + got);
+		}
+		else if (got == 0)
+		{
+			client.readClosed = true;   //peer shut down its side, keep answering what it sent
+			return true;
+		}
+		else
+		{
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+	}
+
+	return true;
+}
+
+bool mazeServer::processFrames(mazeConnection & client)
+{
+	size_t used = 0;
+
+	//stop while the client is behind on reading answers; the rest stays in inBuf
+	while (client.inBuf.size() - used >= 4 && client.backlog() <= MAX_BACKLOG)
+	{
+		uint32_t length;
+		memcpy(&length, &client.inBuf[used], 4);
+		length = ntohl(length);
+
+		if (length % MAZE_CELLS != 0 || length > MAX_FRAME)
+		{
+			//malformed frame, we can't resynchronize the stream
+			return false;
+		}
+
+		if (client.inBuf.size() - used - 4 < length)
+		{
+			break;   //rest of the frame hasn't arrived yet
+		}
+
+		//reserve room for the length prefix, then fill in the results behind it
+		size_t header = client.outBuf.size();
+		client.outBuf.resize(header + 4);
+
+		if (length == 0)
+		{
+			writeStats(client.outBuf);
+		}
+
+		for (uint32_t offset = 0; offset < length; offset += MAZE_CELLS)
+		{
+			solveOne(&client.inBuf[used + 4 + offset], client.outBuf);
+		}
+
+		uint32_t outLength = htonl((uint32_t)(client.outBuf.size() - header - 4));
+		memcpy(&client.outBuf[header], &outLength, 4);
+
+		used += 4 + length;
+	}
+
+	client.inBuf.erase(client.inBuf.begin(), client.inBuf.begin() + used);
+	return true;
+}
+
+void mazeServer::solveOne(const char * cells, vector <char> & out)
+{
+	mazeStatus status;
+	bool useCache = cache != 0 && cache->enabled();
+
+	//validate first; an invalid grid is answered without touching the cache
+	solver.reset();
+	status = solver.loadGrid(cells);
+
+	if (status != MAZE_OK)
+	{
+		path.clear();
+	}
+	else if (!useCache || !cache->lookup(cells, mode, status, path))
+	{
+		if (mode == SOLVER_DEADEND_FILL)
+		{
+			solver.pruneDeadEnds();
+		}
+		solver.assignCoords();
+		status = solver.move();
+
+		solver.getSolution(path);
+
+		if (useCache)
+		{
+			cache->store(cells, mode, status, path);
+		}
+	}
+
+	out.push_back((char)status);
+	out.push_back((char)path.size());
+	for (size_t x = 0; x < path.size(); x++)
+	{
+		out.push_back((char)path[x].rowNum);
+		out.push_back((char)path[x].colNum);
+	}
+}
+
+void mazeServer::writeStats(vector <char> & out)
+{
+	uint32_t counters[4] = {0, 0, 0, 0};
+
+	if (cache != 0)
+	{
+		counters[0] = htonl((uint32_t)cache->getHits());
+		counters[1] = htonl((uint32_t)cache->getDiskHits());
+		counters[2] = htonl((uint32_t)cache->getMisses());
+		counters[3] = htonl((uint32_t)cache->getSize());
+	}
+
+	out.insert(out.end(), (char *)counters, (char *)counters + sizeof(counters));
+}
+
+bool mazeServer::writeClient(mazeConnection & client)
+{
+	while (client.backlog() > 0)
+	{
+		ssize_t sent = write(client.fd, &client.outBuf[client.outSent], client.outBuf.size() - client.outSent);
+
+		if (sent == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			{
+				return true;   //socket is full, poll will tell us when to resume
+			}
+			return false;
+		}
+
+		client.outSent += sent;
+	}
+
+	//everything written; keep the capacity for the next batch
+	client.outBuf.clear();
+	client.outSent = 0;
+	return true;
+}
+
+void mazeServer::closeClient(size_t index)
+{
+	close(clients[index].fd);
+	clients.erase(clients.begin() + index);
+}
+
+#endif